@@ -25,6 +25,51 @@ import aedi.target.base as base
 from aedi.state import BuildState
 
 
+def _replace_cpp_definitions(source: Path, replacements: dict):
+    # Swap whole function or type definitions, identified by the line they start with,
+    # for code moved to files added by patches
+    with open(source) as f:
+        content = f.read()
+
+    if all(signature not in content for signature in replacements):
+        return  # already done by previous configuration of the same source tree
+
+    for signature, replacement in replacements.items():
+        start = content.find(signature)
+        if start == -1:
+            raise RuntimeError(f'Definition of {signature} was not found in {source}')
+
+        start = content.rfind('\n', 0, start) + 1
+        pos = content.index('{', start)
+        depth = 0
+
+        while True:
+            char = content[pos]
+
+            if char in '"\'':
+                pos += 1
+                while content[pos] != char:
+                    pos += 2 if content[pos] == '\\' else 1
+            elif content.startswith('//', pos):
+                pos = content.index('\n', pos)
+            elif content.startswith('/*', pos):
+                pos = content.index('*/', pos) + 1
+            elif char == '{':
+                depth += 1
+            elif char == '}':
+                depth -= 1
+                if depth == 0:
+                    break
+
+            pos += 1
+
+        end = content.find('\n', pos) + 1 or len(content)
+        content = content[:start] + replacement + content[end:]
+
+    with open(source, 'w') as f:
+        f.write(content)
+
+
 class Ad9361Target(base.CMakeSharedDependencyTarget):
     def __init__(self, name='ad9361'):
         super().__init__(name)
@@ -122,7 +167,16 @@ class Codec2Target(base.CMakeStaticDependencyTarget):
     def prepare_source(self, state: BuildState):
         state.download_source(
             'https://github.com/drowe67/codec2/archive/refs/tags/1.2.0.tar.gz',
-            'cbccae52b2c2ecc5d2757e407da567eb681241ff8dadce39d779a7219dbcf449')
+            'cbccae52b2c2ecc5d2757e407da567eb681241ff8dadce39d779a7219dbcf449',
+            patches=(
+                'codec2-typed-fifo',
+                'codec2-multichannel-rx',
+                'codec2-simd-ofdm',
+                'codec2-batch-data-rx',
+                'codec2-polyphase-resample',
+                'codec2-shared-tables',
+                'codec2-simd-cohpsk',
+            ))
 
     def configure(self, state: BuildState):
         state.options['BUILD_OSX_UNIVERSAL'] = 'YES'
@@ -136,7 +190,14 @@ class CorrectTarget(base.CMakeDependencyTarget):
     def prepare_source(self, state: BuildState):
         state.download_source(
             'https://github.com/quiet/libcorrect/archive/f5a28c74fba7a99736fe49d3a5243eca29517ae9.tar.gz',
-            '5a4305aabe6c7d5b58f6677c41c54ad5e8d9003f7a5998f7344d93534e4c5760')
+            '5a4305aabe6c7d5b58f6677c41c54ad5e8d9003f7a5998f7344d93534e4c5760',
+            patches=(
+                'correct-simd-viterbi',
+                'correct-stream-decoder',
+                'correct-puncture-tail-biting',
+                'correct-simd-reed-solomon',
+                'correct-ccsds-pipeline',
+            ))
 
     def post_build(self, state: BuildState):
         super().post_build(state)
@@ -156,7 +217,8 @@ class FftwTarget(base.CMakeSharedDependencyTarget):
     def prepare_source(self, state: BuildState):
         state.download_source(
             'https://fftw.org/fftw-3.3.10.tar.gz',
-            '56c932549852cddcfafdab3820b0200c7742675be92179e59e6215b340e26467')
+            '56c932549852cddcfafdab3820b0200c7742675be92179e59e6215b340e26467',
+            patches='fftw-wisdom-cache')
 
     def configure(self, state: BuildState):
         opts = state.options
@@ -170,6 +232,9 @@ class FftwTarget(base.CMakeSharedDependencyTarget):
             opts['ENABLE_AVX'] = 'YES'
             opts['ENABLE_AVX2'] = 'YES'
 
+        # Wisdom is measured by running a tool built for the target architecture
+        opts['GENERATE_WISDOM'] = 'YES' if state.architecture() == os.uname().machine else 'NO'
+
         super().configure(state)
 
         # Patch config header to replace absolute path
@@ -313,7 +378,14 @@ class LimeSuiteTarget(base.CMakeSharedDependencyTarget):
     def prepare_source(self, state: BuildState):
         state.download_source(
             'https://github.com/myriadrf/LimeSuite/archive/refs/tags/v23.11.0.tar.gz',
-            'fd8a448b92bc5ee4012f0ba58785f3c7e0a4d342b24e26275318802dfe00eb33')
+            'fd8a448b92bc5ee4012f0ba58785f3c7e0a4d342b24e26275318802dfe00eb33',
+            patches=(
+                'limesuite-pooled-fifo',
+                'limesuite-simd-packing',
+                'limesuite-batch-read',
+                'limesuite-stream-telemetry',
+                'limesuite-loopback-connection',
+            ))
         state.set_build_datetime(2024, 1, 23)
 
     def configure(self, state: BuildState):
@@ -416,7 +488,33 @@ class RfnmAudioTarget(base.CMakeDependencyTarget):
 
         state.download_source(
             'https://github.com/AlexandreRouma/librfnm/archive/4e804ec4e77b7f5f1082bafb203f5ad97d65f85a.tar.gz',
-            '4067de2a96acf1710a7ce4b991bf976ac42627a545150ab6330b112a7fc8147b')
+            '4067de2a96acf1710a7ce4b991bf976ac42627a545150ab6330b112a7fc8147b',
+            patches=(
+                'rfnm-lock-free-rx-queues',
+                'rfnm-reorder-window',
+                'rfnm-deferred-unpack',
+                'rfnm-aligned-dequeue',
+                'rfnm-simulated-device',
+            ))
+
+    def configure(self, state: BuildState):
+        # Receive path and transfer threads are implemented in files added by patches
+        _replace_cpp_definitions(state.source / 'src/librfnm.cpp', {
+            'struct _librfnm_usb_handle {': '#include "librfnm_usb.h"\n',
+            'librfnm_rx_buf_s::librfnm_rx_buf_s(': '',
+            'void librfnm::threadfn(': '',
+            'rfnm_api_failcode librfnm::rx_qbuf(': '',
+            'rfnm_api_failcode librfnm::rx_dqbuf(': '',
+            'rfnm_api_failcode librfnm::rx_flush(': '',
+            'void librfnm::dqbuf_overwrite_cc(': '',
+            'int librfnm::dqbuf_is_cc_continuous(': '',
+            'bool librfnm::unpack_12_to_cs16(': '',
+            'bool librfnm::unpack_12_to_cf32(': '',
+            'bool librfnm::unpack_12_to_cs8(': '',
+            'void librfnm::pack_cs16_to_12(': '',
+        })
+
+        super().configure(state)
 
 
 class RtAudioTarget(base.CMakeSharedDependencyTarget):
@@ -74,6 +74,12 @@ class SdrPlusPlusBaseTarget(CMakeMainTarget):
                 dylib = f'lib{dependency}.dylib'
                 hardcopy(self.state.lib_path / dylib, self.lib_path / dylib)
 
+            # FFTW looks for its wisdom relative to the directory of its library
+            wisdom_path = self.state.lib_path.parent / 'share/fftw3/wisdom'
+
+            if wisdom_path.exists():
+                hardcopy_directory(wisdom_path, self.contents_path / 'share/fftw3/wisdom')
+
             plugins_path = self.contents_path / 'Plugins'
             os.mkdir(plugins_path)
 